@@ -0,0 +1,279 @@
+#define _GNU_SOURCE
+#include <sched.h>
+#include <dirent.h>
+
+#include "affinity.h"
+#include "sched.h"
+
+/**
+ * Reads the NUMA node of a CPU from sysfs (the cpu<N>/node<M> entry)
+ * @param (cpu) : the CPU number
+ * @return : NUMA node of CPU (0 if system has no NUMA information)
+ */
+static int readNodeOfCPU(int cpu) {
+    char path[64];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d", cpu);
+
+    DIR *dir = opendir(path);
+    if (dir == NULL) return 0;
+
+    int node = 0;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (strncmp(entry->d_name, "node", 4) == 0 && isdigit((unsigned char) entry->d_name[4])) {
+            node = atoi(entry->d_name + 4);
+            break;
+        }
+    }
+    closedir(dir);
+    return node;
+}
+
+/**
+ * Calculates the time elapsed between two points in time
+ * @param (from) : the earlier time
+ * @param (to) : the later time
+ * @return : elapsed time in nanoseconds
+ */
+static long long elapsedTime(struct timespec *from, struct timespec *to) {
+    return (long long) (to->tv_sec - from->tv_sec) * 1000000000LL + (to->tv_nsec - from->tv_nsec);
+}
+
+/**
+ * Reads the time each CPU spent busy (user, nice, system, irq, softirq and steal time of /proc/stat)
+ * @param (placement) : the placement data
+ * @param (busy_time) : array of num_cpus busy times (ns) to populate (CPUs missing from /proc/stat are left as is)
+ * @return : true if /proc/stat was read; false otherwise
+ */
+static bool readBusyTime(Placement *placement, long long *busy_time) {
+    FILE *fp = fopen("/proc/stat", "r");
+    if (fp == NULL) return false;
+
+    long long tick = 1000000000LL / sysconf(_SC_CLK_TCK);
+
+    char *line = NULL;
+    size_t length = 0;
+
+    while (getline(&line, &length, fp) != -1) {
+        //per-CPU lines follow the aggregate "cpu " line; stop at the first line that is not a CPU
+        if (strncmp(line, "cpu", 3) != 0) break;
+        if (!isdigit((unsigned char) line[3])) continue;
+
+        int cpu;
+        long long user, nice, system, idle, iowait, irq, softirq, steal;
+        if (sscanf(line + 3, "%d %lld %lld %lld %lld %lld %lld %lld %lld",
+                   &cpu, &user, &nice, &system, &idle, &iowait, &irq, &softirq, &steal) != 9) continue;
+        if (cpu < 0 || cpu >= placement->num_cpus) continue;
+
+        busy_time[cpu] = (user + nice + system + irq + softirq + steal) * tick;
+    }
+
+    free(line);
+    fclose(fp);
+    return true;
+}
+
+/**
+ * Resamples per-CPU load if the last sample is older than LOAD_SAMPLE_INTERVAL. The load of a CPU is the
+ * fraction of the interval it was busy, less the time the scheduled jobs themselves used on it.
+ * @param (placement) : the placement data
+ */
+static void sampleLoad(Placement *placement) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    long long elapsed = elapsedTime(&placement->sampled, &now);
+    if (elapsed < LOAD_SAMPLE_INTERVAL * 1000LL) return;
+
+    long long *busy_time = malloc(placement->num_cpus * sizeof(long long));
+    memcpy(busy_time, placement->busy_time, placement->num_cpus * sizeof(long long));
+
+    if (readBusyTime(placement, busy_time)) {
+        for (int cpu = 0; cpu < placement->num_cpus; cpu++) {
+            long long other = busy_time[cpu] - placement->busy_time[cpu] - placement->job_time[cpu];
+            double load = (double) other / (double) elapsed;
+
+            placement->load[cpu] = load < 0 ? 0 : (load > 1 ? 1 : load);
+            placement->busy_time[cpu] = busy_time[cpu];
+            placement->job_time[cpu] = 0;
+        }
+        placement->sampled = now;
+    }
+    free(busy_time);
+}
+
+/**
+ * Creates placement data from the CPUs the scheduler itself is allowed to run on
+ * @return : Placement object (NULL if topology cannot be read)
+ */
+Placement *createPlacement(void) {
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    if (sched_getaffinity(0, sizeof(mask), &mask) != 0) {
+        perror("ERROR : cannot read CPU affinity");
+        return NULL;
+    }
+
+    int num_cpus = (int) sysconf(_SC_NPROCESSORS_CONF);
+    if (num_cpus <= 0) return NULL;
+    if (num_cpus > CPU_SETSIZE) num_cpus = CPU_SETSIZE;
+
+    Placement *placement = malloc(sizeof(Placement));
+    placement->num_cpus = num_cpus;
+    placement->allowed = calloc(num_cpus, sizeof(bool));
+    placement->node = calloc(num_cpus, sizeof(int));
+    placement->load = calloc(num_cpus, sizeof(double));
+    placement->busy_time = calloc(num_cpus, sizeof(long long));
+    placement->job_time = calloc(num_cpus, sizeof(long long));
+    placement->homed = calloc(num_cpus, sizeof(int));
+    placement->last_choice = -1;
+
+    for (int cpu = 0; cpu < num_cpus; cpu++) {
+        placement->allowed[cpu] = CPU_ISSET(cpu, &mask);
+        placement->node[cpu] = readNodeOfCPU(cpu);
+    }
+
+    //first sample is the baseline : load is 0 until LOAD_SAMPLE_INTERVAL has passed
+    readBusyTime(placement, placement->busy_time);
+    clock_gettime(CLOCK_MONOTONIC, &placement->sampled);
+    return placement;
+}
+
+/**
+ * Frees memory of Placement object
+ * @param (placement) : the Placement object to free
+ */
+void freePlacement(Placement *placement) {
+    if (placement == NULL) return;
+    free(placement->allowed);
+    free(placement->node);
+    free(placement->load);
+    free(placement->busy_time);
+    free(placement->job_time);
+    free(placement->homed);
+    free(placement);
+}
+
+/**
+ * Reads the CPU a process last executed on (field 39 of /proc/<pid>/stat)
+ * @param (pid) : process ID of process
+ * @return : CPU number (-1 if it cannot be read)
+ */
+int readLastCPU(pid_t pid) {
+    char cpu[16];
+    if (!readProcStatField(pid, 39, cpu, sizeof(cpu))) return -1;
+    return atoi(cpu);
+}
+
+/**
+ * Finds the least loaded allowed CPU. CPUs within LOAD_TIE_THRESHOLD of the lowest load count as equally loaded :
+ * of those, the CPU fewest jobs call home is chosen, and remaining ties are broken round robin, so that jobs are
+ * spread over idle CPUs instead of all landing on the lowest numbered one
+ * @param (placement) : the placement data
+ * @param (node) : only consider CPUs on this NUMA node (-1 for any node)
+ * @return : least loaded CPU (-1 if none found)
+ */
+static int leastLoadedCPU(Placement *placement, int node) {
+    double lowest = -1;
+    for (int cpu = 0; cpu < placement->num_cpus; cpu++) {
+        if (!placement->allowed[cpu]) continue;
+        if (node >= 0 && placement->node[cpu] != node) continue;
+        if (lowest < 0 || placement->load[cpu] < lowest) lowest = placement->load[cpu];
+    }
+    if (lowest < 0) return -1;
+
+    //scan starts after the last chosen CPU, so equally loaded CPUs with as many homed jobs take turns
+    int best = -1;
+    for (int i = 1; i <= placement->num_cpus; i++) {
+        int cpu = (placement->last_choice + i + placement->num_cpus) % placement->num_cpus;
+        if (!placement->allowed[cpu]) continue;
+        if (node >= 0 && placement->node[cpu] != node) continue;
+        if (placement->load[cpu] > lowest + LOAD_TIE_THRESHOLD) continue;
+        if (best < 0 || placement->homed[cpu] < placement->homed[best]) best = cpu;
+    }
+    return best;
+}
+
+/**
+ * Chooses the CPU to resume a job on. Keeps the job on its last CPU unless other work keeps that CPU
+ * busy more than MIGRATION_THRESHOLD above the least loaded CPU, in which case the least loaded CPU
+ * (preferring the same NUMA node) is chosen. Per-CPU load is resampled from /proc/stat when stale.
+ * @param (placement) : the placement data
+ * @param (last_cpu) : CPU the job last executed on (-1 if job has not yet executed)
+ * @return : the CPU to resume the job on (-1 if no placement is possible)
+ */
+int choosePlacement(Placement *placement, int last_cpu) {
+    if (placement == NULL) return -1;
+
+    sampleLoad(placement);
+
+    int least = leastLoadedCPU(placement, -1);
+    if (least < 0) return -1;
+
+    //job has no home yet : place it on the least loaded CPU
+    if (last_cpu < 0 || last_cpu >= placement->num_cpus || !placement->allowed[last_cpu]) {
+        placement->last_choice = least;
+        return least;
+    }
+
+    //stay on last CPU to keep caches and node-local memory warm while imbalance is small
+    if (placement->load[last_cpu] - placement->load[least] <= MIGRATION_THRESHOLD) return last_cpu;
+
+    //migrate, preferring a CPU on the same NUMA node
+    int local = leastLoadedCPU(placement, placement->node[last_cpu]);
+    if (local >= 0 && placement->load[last_cpu] - placement->load[local] > MIGRATION_THRESHOLD) least = local;
+    placement->last_choice = least;
+    return least;
+}
+
+/**
+ * Moves a job's home from one CPU to another, keeping the number of jobs homed on each CPU
+ * @param (placement) : the placement data
+ * @param (from_cpu) : CPU job was homed on (-1 if job had no home yet)
+ * @param (to_cpu) : CPU job is now homed on (-1 if job has terminated)
+ */
+void moveHome(Placement *placement, int from_cpu, int to_cpu) {
+    if (placement == NULL || from_cpu == to_cpu) return;
+    if (from_cpu >= 0 && from_cpu < placement->num_cpus && placement->homed[from_cpu] > 0) {
+        placement->homed[from_cpu] -= 1;
+    }
+    if (to_cpu >= 0 && to_cpu < placement->num_cpus) placement->homed[to_cpu] += 1;
+}
+
+/**
+ * Records CPU time a scheduled job used on a CPU, so it is not counted as load from other work
+ * @param (placement) : the placement data
+ * @param (cpu) : the CPU job executed on
+ * @param (run_time) : CPU time (ns) job used since it was last recorded
+ */
+void addJobTime(Placement *placement, int cpu, long long run_time) {
+    if (placement == NULL || cpu < 0 || cpu >= placement->num_cpus || run_time <= 0) return;
+    placement->job_time[cpu] += run_time;
+}
+
+/**
+ * Gets the NUMA node of a CPU
+ * @param (placement) : the placement data
+ * @param (cpu) : the CPU number
+ * @return : NUMA node of CPU (-1 if unknown)
+ */
+int nodeOfCPU(Placement *placement, int cpu) {
+    if (placement == NULL || cpu < 0 || cpu >= placement->num_cpus) return -1;
+    return placement->node[cpu];
+}
+
+/**
+ * Restricts a process to a single CPU through its affinity mask
+ * NOTE : the kernel cannot move a pinned process; placement is only reconsidered when it is next resumed
+ * @param (pid) : process ID of process to pin
+ * @param (cpu) : the CPU to pin process to
+ * @return : 0 on success; -1 otherwise
+ */
+int pinToCPU(pid_t pid, int cpu) {
+    if (cpu < 0 || cpu >= CPU_SETSIZE) return -1;
+
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    CPU_SET(cpu, &mask);
+    return sched_setaffinity(pid, sizeof(mask), &mask);
+}
@@ -0,0 +1,104 @@
+#ifndef AFFINITY_H
+#define AFFINITY_H
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include <sys/types.h>
+
+/**
+ * Fraction of time a job's last CPU may be busy with other work above the least loaded CPU before the job is migrated
+ */
+#define MIGRATION_THRESHOLD 0.5
+
+/**
+ * Minimum interval (microseconds) between two samples of per-CPU load from /proc/stat
+ */
+#define LOAD_SAMPLE_INTERVAL 100000
+
+/**
+ * Difference in load below which two CPUs count as equally loaded; ties go to the CPU fewer jobs call home
+ */
+#define LOAD_TIE_THRESHOLD 0.05
+
+/**
+ * CPU topology and per-CPU load used to place jobs on their last CPU/NUMA node
+ */
+typedef struct Placement {
+    int num_cpus; //number of CPUs known to the system
+    bool *allowed; //1 if scheduler may place jobs on CPU; 0 otherwise
+    int *node; //NUMA node of each CPU
+    double *load; //fraction of last sample interval each CPU was busy with work other than the scheduled jobs
+    long long *busy_time; //busy time (ns) of each CPU in /proc/stat at last sample
+    long long *job_time; //CPU time (ns) the scheduled jobs used on each CPU since last sample
+    struct timespec sampled; //time of last sample
+    int *homed; //number of unfinished jobs whose last CPU is each CPU
+    int last_choice; //CPU last chosen from the least loaded CPUs (remaining ties are broken round robin after it)
+} Placement;
+
+/**
+ * Creates placement data from the CPUs the scheduler itself is allowed to run on
+ * @return : Placement object (NULL if topology cannot be read)
+ */
+Placement *createPlacement(void);
+
+/**
+ * Frees memory of Placement object
+ * @param (placement) : the Placement object to free
+ */
+void freePlacement(Placement *placement);
+
+/**
+ * Reads the CPU a process last executed on (field 39 of /proc/<pid>/stat)
+ * @param (pid) : process ID of process
+ * @return : CPU number (-1 if it cannot be read)
+ */
+int readLastCPU(pid_t pid);
+
+/**
+ * Chooses the CPU to resume a job on. Keeps the job on its last CPU unless other work keeps that CPU
+ * busy more than MIGRATION_THRESHOLD above the least loaded CPU, in which case the least loaded CPU
+ * (preferring the same NUMA node) is chosen. Per-CPU load is resampled from /proc/stat when stale.
+ * @param (placement) : the placement data
+ * @param (last_cpu) : CPU the job last executed on (-1 if job has not yet executed)
+ * @return : the CPU to resume the job on (-1 if no placement is possible)
+ */
+int choosePlacement(Placement *placement, int last_cpu);
+
+/**
+ * Moves a job's home from one CPU to another, keeping the number of jobs homed on each CPU
+ * @param (placement) : the placement data
+ * @param (from_cpu) : CPU job was homed on (-1 if job had no home yet)
+ * @param (to_cpu) : CPU job is now homed on (-1 if job has terminated)
+ */
+void moveHome(Placement *placement, int from_cpu, int to_cpu);
+
+/**
+ * Records CPU time a scheduled job used on a CPU, so it is not counted as load from other work
+ * @param (placement) : the placement data
+ * @param (cpu) : the CPU job executed on
+ * @param (run_time) : CPU time (ns) job used since it was last recorded
+ */
+void addJobTime(Placement *placement, int cpu, long long run_time);
+
+/**
+ * Gets the NUMA node of a CPU
+ * @param (placement) : the placement data
+ * @param (cpu) : the CPU number
+ * @return : NUMA node of CPU (-1 if unknown)
+ */
+int nodeOfCPU(Placement *placement, int cpu);
+
+/**
+ * Restricts a process to a single CPU through its affinity mask
+ * NOTE : the kernel cannot move a pinned process; placement is only reconsidered when it is next resumed
+ * @param (pid) : process ID of process to pin
+ * @param (cpu) : the CPU to pin process to
+ * @return : 0 on success; -1 otherwise
+ */
+int pinToCPU(pid_t pid, int cpu);
+#endif
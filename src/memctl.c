@@ -0,0 +1,87 @@
+#include "memctl.h"
+
+/**
+ * Reads host memory pressure ("some avg10" of /proc/pressure/memory)
+ * @return : percentage of time tasks stalled on memory over last 10 seconds (-1 if PSI is unavailable)
+ */
+double readMemoryPressure(void) {
+    FILE *fp = fopen("/proc/pressure/memory", "r");
+    if (fp == NULL) return -1;
+
+    double avg10 = -1;
+    if (fscanf(fp, "some avg10=%lf", &avg10) != 1) avg10 = -1;
+
+    fclose(fp);
+    return avg10;
+}
+
+/**
+ * Reads memory available for new allocations without swapping (MemAvailable of /proc/meminfo)
+ * @return : available memory in kB (-1 if it cannot be read)
+ */
+long readAvailableMemory(void) {
+    FILE *fp = fopen("/proc/meminfo", "r");
+    if (fp == NULL) return -1;
+
+    char *line = NULL;
+    size_t length = 0;
+    long available = -1;
+
+    while (getline(&line, &length, fp) != -1) {
+        if (sscanf(line, "MemAvailable: %ld kB", &available) == 1) break;
+    }
+
+    free(line);
+    fclose(fp);
+    return available;
+}
+
+/**
+ * Reads the resident set size of a process (/proc/<pid>/statm)
+ * @param (pid) : process ID of process
+ * @return : resident set size in kB (-1 if it cannot be read)
+ */
+long readRSS(pid_t pid) {
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/statm", pid);
+
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL) return -1;
+
+    long size, resident;
+    int read = fscanf(fp, "%ld %ld", &size, &resident);
+    fclose(fp);
+
+    if (read != 2) return -1;
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+/**
+ * Decides whether a job may be started/resumed given current memory pressure and available memory
+ * A job that has not run yet has unknown memory needs and is only started while pressure is at or below
+ * MEMORY_PRESSURE_THRESHOLD; every job needs MEMORY_RESERVE_KB (plus its predicted growth) to be available
+ * @param (rss_kb) : current resident set size of job in kB (-1 if job has not run yet)
+ * @param (growth_kb) : predicted growth of job's resident set during its next CPU burst in kB
+ * @return : true if job may run; false if job should stay parked (stopped)
+ */
+bool admitJob(long rss_kb, long growth_kb) {
+    //job has not run yet : it may be memory-hungry, so do not start it while memory is under pressure
+    if (rss_kb < 0 && readMemoryPressure() > MEMORY_PRESSURE_THRESHOLD) return false;
+    if (shouldPark(rss_kb)) return false;
+
+    //job's current resident set is already accounted for; its growth and the reserve need to fit
+    long available = readAvailableMemory();
+    if (available >= 0 && (growth_kb > 0 ? growth_kb : 0) + MEMORY_RESERVE_KB > available) return false;
+
+    return true;
+}
+
+/**
+ * Decides whether a running job should be parked because memory pressure has risen
+ * @param (rss_kb) : current resident set size of job in kB
+ * @return : true if job is memory-hungry and pressure is above MEMORY_PRESSURE_THRESHOLD
+ */
+bool shouldPark(long rss_kb) {
+    if (rss_kb < MEMORY_HUNGRY_KB) return false;
+    return readMemoryPressure() > MEMORY_PRESSURE_THRESHOLD;
+}
@@ -0,0 +1,71 @@
+#ifndef MEMCTL_H
+#define MEMCTL_H
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <sys/types.h>
+
+/**
+ * Memory pressure ("some avg10" of /proc/pressure/memory, in percent) above which memory-hungry jobs are parked
+ */
+#define MEMORY_PRESSURE_THRESHOLD 10.0
+
+/**
+ * Resident set size (kB) at or above which a job counts as memory-hungry
+ */
+#define MEMORY_HUNGRY_KB (64 * 1024)
+
+/**
+ * Memory (kB) kept free on the host when admitting jobs
+ */
+#define MEMORY_RESERVE_KB (128 * 1024)
+
+/**
+ * Interval (microseconds) at which memory pressure is polled while a job runs or waits for admission
+ */
+#define MEMORY_POLL_INTERVAL 100000
+
+/**
+ * Maximum time (microseconds) a run-to-completion scheduler waits for a job to be admitted
+ */
+#define ADMISSION_MAX_WAIT 5000000
+
+/**
+ * Reads host memory pressure ("some avg10" of /proc/pressure/memory)
+ * @return : percentage of time tasks stalled on memory over last 10 seconds (-1 if PSI is unavailable)
+ */
+double readMemoryPressure(void);
+
+/**
+ * Reads memory available for new allocations without swapping (MemAvailable of /proc/meminfo)
+ * @return : available memory in kB (-1 if it cannot be read)
+ */
+long readAvailableMemory(void);
+
+/**
+ * Reads the resident set size of a process (/proc/<pid>/statm)
+ * @param (pid) : process ID of process
+ * @return : resident set size in kB (-1 if it cannot be read)
+ */
+long readRSS(pid_t pid);
+
+/**
+ * Decides whether a job may be started/resumed given current memory pressure and available memory
+ * A job that has not run yet has unknown memory needs and is only started while pressure is at or below
+ * MEMORY_PRESSURE_THRESHOLD; every job needs MEMORY_RESERVE_KB (plus its predicted growth) to be available
+ * @param (rss_kb) : current resident set size of job in kB (-1 if job has not run yet)
+ * @param (growth_kb) : predicted growth of job's resident set during its next CPU burst in kB
+ * @return : true if job may run; false if job should stay parked (stopped)
+ */
+bool admitJob(long rss_kb, long growth_kb);
+
+/**
+ * Decides whether a running job should be parked because memory pressure has risen
+ * @param (rss_kb) : current resident set size of job in kB
+ * @return : true if job is memory-hungry and pressure is above MEMORY_PRESSURE_THRESHOLD
+ */
+bool shouldPark(long rss_kb);
+#endif
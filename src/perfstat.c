@@ -0,0 +1,157 @@
+#include <errno.h>
+#include <linux/perf_event.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+
+#include "perfstat.h"
+
+/**
+ * perf event type and config of every PerfCounter (indexed by PerfCounter)
+ */
+static const struct {
+    __u32 type;
+    __u64 config;
+    const char *name;
+} PERF_EVENTS[NUM_PERF_COUNTERS] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, "cycles"},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, "instructions"},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES, "cache references"},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, "cache misses"},
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES, "context switches"},
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_MIGRATIONS, "CPU migrations"},
+};
+
+/**
+ * Raises the soft limit on open file descriptors to the hard limit
+ * @return : true if the limit was raised; false otherwise
+ */
+static bool raiseFileLimit(void) {
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) != 0 || limit.rlim_cur >= limit.rlim_max) return false;
+
+    limit.rlim_cur = limit.rlim_max;
+    return setrlimit(RLIMIT_NOFILE, &limit) == 0;
+}
+
+/**
+ * Opens a perf_event_open counter on a process for every PerfCounter
+ * Counters start disabled and are enabled when the process calls exec, so they cover only the executed program
+ * NOTE : counters that are not supported (e.g. no PMU in virtual machines, or kernel-mode software events
+ * when perf_event_paranoid = 2 for unprivileged users) get a file descriptor of -1
+ * NOTE : each process holds NUM_PERF_COUNTERS descriptors until it is reaped; if the scheduler runs out of
+ * descriptors the soft limit is raised to the hard limit, and an error is printed if that is not enough
+ * @param (pid) : process ID of process to count
+ * @param (fds) : array of NUM_PERF_COUNTERS file descriptors to populate
+ */
+void openPerfCounters(pid_t pid, int *fds) {
+    for (int i = 0; i < NUM_PERF_COUNTERS; i++) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_EVENTS[i].type;
+        attr.config = PERF_EVENTS[i].config;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        attr.exclude_hv = 1;
+
+        //count only the job's program : start counting when child calls execv
+        attr.disabled = 1;
+        attr.enable_on_exec = 1;
+
+        //hardware events count user mode only (allowed when perf_event_paranoid = 2); software events
+        //(context switches, migrations) only fire in kernel mode, so they cannot be restricted to user mode :
+        //if an unprivileged user may not count kernel mode they are left unavailable rather than read as 0
+        attr.exclude_kernel = (PERF_EVENTS[i].type == PERF_TYPE_HARDWARE);
+
+        //count process on any CPU; close on exec so later children do not inherit the descriptor
+        fds[i] = (int) syscall(SYS_perf_event_open, &attr, pid, -1, -1, PERF_FLAG_FD_CLOEXEC);
+
+        //out of file descriptors : retry after raising the limit, otherwise report it rather than show [n/a]
+        if (fds[i] < 0 && errno == EMFILE && raiseFileLimit()) {
+            i -= 1;
+            continue;
+        }
+        if (fds[i] < 0 && (errno == EMFILE || errno == ENFILE)) {
+            fprintf(stderr, "ERROR : cannot open performance counters for PID = [%d] : %s\n", pid, strerror(errno));
+            for (int j = i + 1; j < NUM_PERF_COUNTERS; j++) fds[j] = -1;
+            return;
+        }
+    }
+}
+
+/**
+ * Reads the current (cumulative) value of every counter, scaled for multiplexing
+ * @param (fds) : array of NUM_PERF_COUNTERS file descriptors
+ * @param (values) : array of NUM_PERF_COUNTERS values to populate (-1 for unavailable counters)
+ */
+void readPerfCounters(int *fds, long long *values) {
+    for (int i = 0; i < NUM_PERF_COUNTERS; i++) {
+        values[i] = -1;
+        if (fds[i] < 0) continue;
+
+        //value, time enabled, time running
+        __u64 data[3];
+        if (read(fds[i], data, sizeof(data)) != (ssize_t) sizeof(data)) continue;
+
+        if (data[2] == 0) {//counter never scheduled on PMU
+            values[i] = 0;
+        }
+        else if (data[2] < data[1]) {//counter was multiplexed : extrapolate to time enabled
+            values[i] = (long long) ((double) data[0] * data[1] / data[2]);
+        }
+        else {
+            values[i] = (long long) data[0];
+        }
+    }
+}
+
+/**
+ * Closes every counter of a process
+ * @param (fds) : array of NUM_PERF_COUNTERS file descriptors
+ */
+void closePerfCounters(int *fds) {
+    for (int i = 0; i < NUM_PERF_COUNTERS; i++) {
+        if (fds[i] >= 0) close(fds[i]);
+        fds[i] = -1;
+    }
+}
+
+/**
+ * Calculates instructions per cycle
+ * @param (values) : array of NUM_PERF_COUNTERS counter values
+ * @return : instructions per cycle (-1 if unavailable)
+ */
+double instructionsPerCycle(long long *values) {
+    if (values[PERF_CYCLES] <= 0 || values[PERF_INSTRUCTIONS] < 0) return -1;
+    return (double) values[PERF_INSTRUCTIONS] / (double) values[PERF_CYCLES];
+}
+
+/**
+ * Calculates cache miss rate as percentage of cache references that missed
+ * @param (values) : array of NUM_PERF_COUNTERS counter values
+ * @return : cache miss rate in percent (-1 if unavailable)
+ */
+double cacheMissRate(long long *values) {
+    if (values[PERF_CACHE_REFERENCES] <= 0 || values[PERF_CACHE_MISSES] < 0) return -1;
+    return 100.0 * (double) values[PERF_CACHE_MISSES] / (double) values[PERF_CACHE_REFERENCES];
+}
+
+/**
+ * Prints the counter values, IPC and miss rate of a process
+ * @param (values) : array of NUM_PERF_COUNTERS counter values
+ */
+void printPerfCounters(long long *values) {
+    printf("   ");
+    for (int i = 0; i < NUM_PERF_COUNTERS; i++) {
+        if (values[i] < 0) printf(" %s = [n/a]", PERF_EVENTS[i].name);
+        else printf(" %s = [%lld]", PERF_EVENTS[i].name, values[i]);
+    }
+
+    double ipc = instructionsPerCycle(values);
+    double miss_rate = cacheMissRate(values);
+
+    if (ipc < 0) printf("\n    IPC = [n/a]");
+    else printf("\n    IPC = [%lf]", ipc);
+
+    if (miss_rate < 0) printf(" cache miss rate = [n/a]\n");
+    else printf(" cache miss rate = [%lf%%]\n", miss_rate);
+}
@@ -0,0 +1,68 @@
+#ifndef PERFSTAT_H
+#define PERFSTAT_H
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <sys/types.h>
+
+/**
+ * Hardware/software performance counters attached to each process
+ */
+typedef enum PerfCounter {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_CACHE_REFERENCES,
+    PERF_CACHE_MISSES,
+    PERF_CONTEXT_SWITCHES,
+    PERF_CPU_MIGRATIONS,
+    NUM_PERF_COUNTERS
+} PerfCounter;
+
+/**
+ * Opens a perf_event_open counter on a process for every PerfCounter
+ * Counters start disabled and are enabled when the process calls exec, so they cover only the executed program
+ * NOTE : counters that are not supported (e.g. no PMU in virtual machines, or kernel-mode software events
+ * when perf_event_paranoid = 2 for unprivileged users) get a file descriptor of -1
+ * NOTE : each process holds NUM_PERF_COUNTERS descriptors until it is reaped; if the scheduler runs out of
+ * descriptors the soft limit is raised to the hard limit, and an error is printed if that is not enough
+ * @param (pid) : process ID of process to count
+ * @param (fds) : array of NUM_PERF_COUNTERS file descriptors to populate
+ */
+void openPerfCounters(pid_t pid, int *fds);
+
+/**
+ * Reads the current (cumulative) value of every counter, scaled for multiplexing
+ * @param (fds) : array of NUM_PERF_COUNTERS file descriptors
+ * @param (values) : array of NUM_PERF_COUNTERS values to populate (-1 for unavailable counters)
+ */
+void readPerfCounters(int *fds, long long *values);
+
+/**
+ * Closes every counter of a process
+ * @param (fds) : array of NUM_PERF_COUNTERS file descriptors
+ */
+void closePerfCounters(int *fds);
+
+/**
+ * Calculates instructions per cycle
+ * @param (values) : array of NUM_PERF_COUNTERS counter values
+ * @return : instructions per cycle (-1 if unavailable)
+ */
+double instructionsPerCycle(long long *values);
+
+/**
+ * Calculates cache miss rate as percentage of cache references that missed
+ * @param (values) : array of NUM_PERF_COUNTERS counter values
+ * @return : cache miss rate in percent (-1 if unavailable)
+ */
+double cacheMissRate(long long *values);
+
+/**
+ * Prints the counter values, IPC and miss rate of a process
+ * @param (values) : array of NUM_PERF_COUNTERS counter values
+ */
+void printPerfCounters(long long *values);
+#endif
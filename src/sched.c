@@ -1,5 +1,84 @@
 #include "sched.h"
 
+/**
+ * Reads a field of /proc/<pid>/stat
+ * @param (pid) : process ID of process
+ * @param (field) : the field number (1-based, as in proc(5))
+ * @param (value) : buffer to copy field into
+ * @param (length) : size of value buffer
+ * @return : true if field was read; false otherwise
+ */
+bool readProcStatField(pid_t pid, int field, char *value, size_t length) {
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL) return false;
+
+    char buffer[1024];
+    size_t read = fread(buffer, 1, sizeof(buffer) - 1, fp);
+    fclose(fp);
+    buffer[read] = '\0';
+
+    //program name (field 2) may contain spaces, so start after its closing bracket
+    char *start = strrchr(buffer, ')');
+    if (start == NULL || field < 3) return false;
+
+    //fields after program name start at field 3 (state)
+    int index = 2;
+    char *token = strtok(start + 1, " ");
+    while (token) {
+        index++;
+        if (index == field) {
+            snprintf(value, length, "%s", token);
+            return true;
+        }
+        token = strtok(NULL, " ");
+    }
+    return false;
+}
+
+/**
+ * Checks whether a process is blocked (sleeping or waiting on I/O) according to /proc/<pid>/stat
+ * @param (pid) : process ID of process
+ * @return : true if process is in state S (sleeping) or D (uninterruptible wait); false otherwise
+ */
+bool isBlocked(pid_t pid) {
+    char state[8];
+    if (!readProcStatField(pid, 3, state, sizeof(state))) return false;
+    return state[0] == 'S' || state[0] == 'D';
+}
+
+/**
+ * Checks whether a process has exited, without reaping it
+ * @param (pid) : process ID of process
+ * @return : true if process has exited (is a zombie); false otherwise
+ */
+bool hasExited(pid_t pid) {
+    siginfo_t info;
+    info.si_pid = 0;
+    return waitid(P_PID, pid, &info, WEXITED | WNOHANG | WNOWAIT) == 0 && info.si_pid == pid;
+}
+
+/**
+ * Reads the time a process has spent executing on a CPU (first field of /proc/<pid>/schedstat)
+ * @param (pid) : process ID of process
+ * @return : CPU time in nanoseconds (-1 if it cannot be read)
+ */
+long long readRunTime(pid_t pid) {
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/schedstat", pid);
+
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL) return -1;
+
+    long long run_time = -1;
+    if (fscanf(fp, "%lld", &run_time) != 1) run_time = -1;
+
+    fclose(fp);
+    return run_time;
+}
+
 /**
  * Splits string into array using spaces as delimeter
  * @param (str) : the string to split
@@ -62,6 +141,7 @@ PCB *createPCB(char *path, int priority, pid_t pid, int size, PCB *prev, PCB *ne
     process->priority = priority;
     process->pid = pid;
     process->size = size;
+    for (int i = 0; i < NUM_PERF_COUNTERS; i++) process->perf_fds[i] = -1;
     process->prev = prev;
     process->next = next;
 
@@ -108,7 +188,9 @@ PCB *createPCBList(char *config_file, PCB *pcb_list, size_t *num_processes) {
 
         if (pid < 0) fprintf(stderr, "Failure to execute process [%d] [%s]\n", pid, strArr[1]);
         else if (pid > 0){ //parent process
-            kill(pid, SIGSTOP); //stop the child process
+            //wait until the child has stopped itself before execv
+            int status;
+            waitpid(pid, &status, WUNTRACED);
 
             //for shortest job first scheduling
             int process_size = 0;
@@ -119,12 +201,18 @@ PCB *createPCBList(char *config_file, PCB *pcb_list, size_t *num_processes) {
             //Create PCB for process
             PCB *process = createPCB(strArr[1], atoi(strArr[0]), pid, process_size, NULL, pcb_list);
 
+            //attach performance counters to child process (enabled once it calls execv)
+            openPerfCounters(pid, process->perf_fds);
+
             if (pcb_list) {
                 pcb_list->prev = process;
             }
             pcb_list = process;
         }
         else {//child process
+            //stop until scheduled, so counters are attached before the program is executed
+            raise(SIGSTOP);
+
             //Make system call to execute program from child process
             execv(strArr[1], args);
         }
@@ -158,6 +246,7 @@ void freePCBList(PCB *pcb_list){
     while (pcb_list) {
         PCB *next = pcb_list->next;
         free(pcb_list->path);
+        closePerfCounters(pcb_list->perf_fds);
 
         kill(pcb_list->pid, SIGTERM);//terminate the process completely
 
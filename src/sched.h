@@ -13,6 +13,8 @@
 #include <ctype.h>
 #include <assert.h>
 
+#include "perfstat.h"
+
 /**
  * PCB linked list struct
  */
@@ -21,6 +23,7 @@ typedef struct PCB {
     int priority; //priority rating
     pid_t pid; //Process ID of process to execute program
     int size; //size of process
+    int perf_fds[NUM_PERF_COUNTERS]; //perf_event_open counters attached to process (-1 if unavailable)
 
     struct PCB *prev; //next PCB
     struct PCB *next; //previous PCB
@@ -53,6 +56,37 @@ PCB *createPCB(char *path, int priority, pid_t pid, int size, PCB *prev, PCB *ne
  */
 void freePCBList(PCB *pcb_list);
 
+/**
+ * Reads a field of /proc/<pid>/stat
+ * @param (pid) : process ID of process
+ * @param (field) : the field number (1-based, as in proc(5))
+ * @param (value) : buffer to copy field into
+ * @param (length) : size of value buffer
+ * @return : true if field was read; false otherwise
+ */
+bool readProcStatField(pid_t pid, int field, char *value, size_t length);
+
+/**
+ * Checks whether a process is blocked (sleeping or waiting on I/O) according to /proc/<pid>/stat
+ * @param (pid) : process ID of process
+ * @return : true if process is in state S (sleeping) or D (uninterruptible wait); false otherwise
+ */
+bool isBlocked(pid_t pid);
+
+/**
+ * Checks whether a process has exited, without reaping it
+ * @param (pid) : process ID of process
+ * @return : true if process has exited (is a zombie); false otherwise
+ */
+bool hasExited(pid_t pid);
+
+/**
+ * Reads the time a process has spent executing on a CPU (first field of /proc/<pid>/schedstat)
+ * @param (pid) : process ID of process
+ * @return : CPU time in nanoseconds (-1 if it cannot be read)
+ */
+long long readRunTime(pid_t pid);
+
 /**
  * Splits string into array using spaces as delimeter
  * @param (str) : the string to split
@@ -16,6 +16,27 @@ ReadyQueue *createQueue(PCB *pcb_list) {
         queue->terminated=0;
         queue->burst_time=0;
         queue->num_bursts=0;
+        queue->last_cpu=-1;
+        queue->last_node=-1;
+        queue->num_migrations=0;
+        queue->run_time=0;
+        for (int i = 0; i < NUM_PERF_COUNTERS; i++) queue->counters[i] = -1;
+        queue->rss_kb = -1;//child has not executed its program yet : first sample is taken after first CPU burst
+        queue->peak_rss_kb = 0;
+        queue->rss_growth_kb = 0;
+        queue->num_parked = 0;
+        queue->parked_next = NULL;
+        queue->blocked = 0;
+        queue->probing = 0;
+        queue->num_yields = 0;
+        queue->blocked_run_time = -1;
+        queue->blocked_since = 0;
+        queue->blocked_time = 0;
+        memset(&queue->recheck_timer, 0, sizeof(Timer));
+        queue->recheck_interval = BLOCKED_POLL_INTERVAL;
+        queue->due_next = NULL;
+        queue->run_next = NULL;
+        queue->run_prev = NULL;
 
         /* Record arrival time (time when process enters ready-queue)  */
         struct timespec arrival;
@@ -34,21 +55,6 @@ ReadyQueue *createQueue(PCB *pcb_list) {
     return prev;
 }
 
-/**
- * Given a ready queue, makes the queue cyclic by connecting head and tail nodes
- * @param (queue) : the ready queue to make cyclic
- */
-void makeQueueCyclic(ReadyQueue *queue) {
-    ReadyQueue *elem = queue;
-
-    while (elem->next) {
-        elem = elem->next;
-    }
-
-    queue->prev = elem;
-    elem->next = queue;
-}
-
 /**
  * frees memory of ReadyQueue by freeing all nodes
  * @param (queue) : ReadyQueue to free memory of
@@ -135,46 +141,147 @@ ReadyQueue *mergeSort(ReadyQueue *queue, int mode){
 
 
 /**
- * Simple Priority Scheduler : execute processes from a ready-queue in order based on priority of processes
- * @param (queue) : ReadyQueue of processes to execute (sorted by priority value)
+ * Holds a process stopped until memory admission control admits it (at most ADMISSION_MAX_WAIT)
+ * Memory pressure is rechecked every MEMORY_POLL_INTERVAL on the timer wheel
+ * @param (wheel) : the timer wheel to wait on (process is admitted at once if NULL)
+ * @param (elem) : ReadyQueue element of process to admit
  */
-void simplePriority(ReadyQueue *queue) {
-    ReadyQueue *head = mergeSort(queue, 1);
+void waitForAdmission(TimerWheel *wheel, ReadyQueue *elem) {
+    if (wheel == NULL) return;
+
+    bool timed_out = false;
+    Timer deadline_timer = {0};//end of longest wait for admission
+    addTimer(wheel, &deadline_timer, ADMISSION_MAX_WAIT, setFlagOnExpiry, &timed_out);
+
+    bool parked = false;
+    while (!timed_out && !admitJob(elem->rss_kb, elem->rss_growth_kb)) {
+        if (!parked) {
+            printf("\nParking [%s] with PID = [%d] until memory pressure drops\n", elem->pcb->path, elem->pcb->pid);
+            elem->num_parked += 1;
+            parked = true;
+        }
+        waitTimerWheelFor(wheel, MEMORY_POLL_INTERVAL);
+    }
+    cancelTimer(wheel, &deadline_timer);
+}
 
-    printf("\n--------------------EXECUTING PROCESSES--------------------\n");
+/**
+ * Executes a process until it terminates (for run-to-completion schedulers) and records its burst, blocked,
+ * turnaround and waiting time. As in round robin, burst time is the CPU time the process used and the rest of its
+ * execution is blocked time. A memory-hungry process is parked (stopped) while memory pressure is high, which does
+ * not change the order in which processes complete. Exit and memory pressure are checked on the timer wheel.
+ * @param (wheel) : the timer wheel to wait on (process is waited for without memory checks if NULL)
+ * @param (elem) : ReadyQueue element of (admitted) process to execute
+ */
+void runToCompletion(TimerWheel *wheel, ReadyQueue *elem) {
+    pid_t pid = elem->pcb->pid;
+
+    //start & end time objects
+    struct timespec start, end;
+    double parked_time = 0;//time process was held stopped because of memory pressure
+    bool exited = false;
+    long long start_run_time = readRunTime(pid);//CPU time of process before it executes
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    //Execute CPU burst
+    kill(pid, SIGCONT);
+
+    //wait until process has exited, parking it while memory pressure is high
+    bool exit_check_due = false, memory_check_due = false;
+    Timer exit_timer = {0};//next check of whether process has exited
+    Timer memory_timer = {0};//next check of memory pressure
+    if (wheel) {
+        addTimer(wheel, &exit_timer, BLOCKED_POLL_INTERVAL, setFlagOnExpiry, &exit_check_due);
+        addTimer(wheel, &memory_timer, MEMORY_POLL_INTERVAL, setFlagOnExpiry, &memory_check_due);
+    }
+    while (wheel) {
+        if (!exit_check_due && !memory_check_due && waitTimerWheel(wheel) < 0) break;
 
-    while (head) {
-        if (head->terminated == 0){
-            pid_t pid = head->pcb->pid;
+        if (exit_check_due) {
+            exit_check_due = false;
+            if ((exited = hasExited(pid))) break;
+            addTimer(wheel, &exit_timer, BLOCKED_POLL_INTERVAL, setFlagOnExpiry, &exit_check_due);
+        }
 
-            printf("\nExecuting CPU burst on [%s] with PID = [%d] and priority = [%d]\n", head->pcb->path, pid, head->pcb->priority);
+        if (memory_check_due) {
+            memory_check_due = false;
+            long rss = readRSS(pid);
+            if (shouldPark(rss)) {
+                struct timespec parked, resumed;
+                kill(pid, SIGSTOP);
+                clock_gettime(CLOCK_MONOTONIC, &parked);
 
-            //start & end time objects
-            struct timespec start, end;
+                elem->rss_kb = rss;
+                waitForAdmission(wheel, elem);
 
-            clock_gettime(CLOCK_MONOTONIC, &start);
+                clock_gettime(CLOCK_MONOTONIC, &resumed);
+                kill(pid, SIGCONT);
+                parked_time += (resumed.tv_sec - parked.tv_sec) + (double)(resumed.tv_nsec - parked.tv_nsec)/1000000000L;
+            }
+            addTimer(wheel, &memory_timer, MEMORY_POLL_INTERVAL, setFlagOnExpiry, &memory_check_due);
+        }
+    }
+    if (wheel) {
+        cancelTimer(wheel, &exit_timer);
+        cancelTimer(wheel, &memory_timer);
+    }
 
-            //Execute CPU burst
-            kill(pid, SIGCONT);
+    //CPU time of process at exit (schedstat is readable until process is reaped)
+    long long end_run_time = exited ? readRunTime(pid) : -1;
+
+    int status;
+    struct rusage usage;
+    pid_t reaped = wait4(pid, &status, 0, &usage);//reap process (waits if it has not exited yet)
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
 
-            int status;
-            waitpid(pid, &status, 0);//wait until process has finished
+    readPerfCounters(elem->pcb->perf_fds, elem->counters);//read counters at exit
+    closePerfCounters(elem->pcb->perf_fds);//final values are read : release descriptors
+    if (reaped == pid && usage.ru_maxrss > elem->peak_rss_kb) elem->peak_rss_kb = usage.ru_maxrss;
 
-            clock_gettime(CLOCK_MONOTONIC, &end);
+    //set turn around time as difference between arrival time and completion time
+    elem->turnaround_time = (end.tv_sec - elem->arrival_time_sec)
+                            + (double)(end.tv_nsec - elem->arrival_time_nano)/1000000000L;
 
-            //set turn around time as difference between arrival time and completion time
-            head->turnaround_time = (end.tv_sec - head->arrival_time_sec)
-                                    + (double)(end.tv_nsec - head->arrival_time_nano)/1000000000L;
+    //time process was parked is waiting time; of the rest, CPU time is burst time and the remainder blocked time
+    double elapsed = (end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec)/1000000000L - parked_time;
+    double cpu_time = (double)(end_run_time - start_run_time)/1000000000L;
+    if (start_run_time >= 0 && end_run_time >= start_run_time && cpu_time < elapsed) {
+        elem->burst_time += cpu_time;
+        elem->blocked_time += elapsed - cpu_time;
+    }
+    else {
+        elem->burst_time += elapsed;
+    }
+    //calculate waiting time as turnaround time not spent executing or blocked
+    elem->waiting_time = elem->turnaround_time - elem->burst_time - elem->blocked_time;
 
-            head->burst_time += (end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec)/1000000000L;
-            //calculate waiting time as difference between turnaround time and burst time
-            head->waiting_time = head->turnaround_time - head->burst_time;
+    elem->num_bursts = 1;
+    elem->terminated = 1;
+}
 
-            head->num_bursts = 1;
-            head->terminated = 1;
+/**
+ * Simple Priority Scheduler : execute processes from a ready-queue in order based on priority of processes
+ * @param (queue) : ReadyQueue of processes to execute (sorted by priority value)
+ */
+void simplePriority(ReadyQueue *queue) {
+    ReadyQueue *head = mergeSort(queue, 1);
+    TimerWheel *wheel = createTimerWheel();//paces exit and memory pressure checks
+
+    printf("\n--------------------EXECUTING PROCESSES--------------------\n");
+
+    while (head) {
+        if (head->terminated == 0){
+            waitForAdmission(wheel, head);//only start process while memory fits
+
+            printf("\nExecuting CPU burst on [%s] with PID = [%d] and priority = [%d]\n", head->pcb->path, head->pcb->pid, head->pcb->priority);
+
+            runToCompletion(wheel, head);
         }
         head=head->next;
     }
+    freeTimerWheel(wheel);
     printf("\n-------------------------FINISHED-------------------------\n");
 }//end simplePriority()
 
@@ -185,99 +292,447 @@ void simplePriority(ReadyQueue *queue) {
  */
 void shortestJobFirst(ReadyQueue *queue) {
     ReadyQueue *head = mergeSort(queue, 2);
+    TimerWheel *wheel = createTimerWheel();//paces exit and memory pressure checks
+
     printf("\n--------------------EXECUTING PROCESSES--------------------\n");
 
     while (head) {
         if (head->terminated == 0){
-            pid_t pid = head->pcb->pid;
+            waitForAdmission(wheel, head);//only start process while memory fits
+
+            printf("\nExecuting CPU burst on [%s] with PID = [%d]\n", head->pcb->path, head->pcb->pid);
 
-            printf("\nExecuting CPU burst on [%s] with PID = [%d]\n", head->pcb->path, pid);
+            runToCompletion(wheel, head);
+        }
+        head=head->next;
+    }
+    freeTimerWheel(wheel);
+    printf("\n-------------------------FINISHED-------------------------\n");
+}//end shortestJobFirst()
 
-            //start & end time objects
-            struct timespec start, end;
+/**
+ * Records turnaround and waiting time of a process that has terminated and been reaped, and closes its
+ * performance counters (their final values must already have been read)
+ * @param (elem) : ReadyQueue element of terminated process
+ * @param (end) : time at which process was found to have terminated
+ * @param (usage) : resource usage of terminated process from wait4 (NULL if wait4 did not reap it)
+ */
+void completeProcess(ReadyQueue *elem, struct timespec *end, struct rusage *usage) {
+    if (usage && usage->ru_maxrss > elem->peak_rss_kb) elem->peak_rss_kb = usage->ru_maxrss;
 
-            clock_gettime(CLOCK_MONOTONIC, &start);
+    //counters were read when process was last preempted : release descriptors
+    closePerfCounters(elem->pcb->perf_fds);
 
-            //Execute CPU burst
-            kill(pid, SIGCONT);
+    //set turn around time as difference between arrival time and completion time
+    elem->turnaround_time = (end->tv_sec - elem->arrival_time_sec)
+                            + (double)(end->tv_nsec - elem->arrival_time_nano)/1000000000L;
+    //calculate waiting time as turnaround time not spent executing or blocked
+    elem->waiting_time = elem->turnaround_time - elem->burst_time - elem->blocked_time;
+
+    elem->blocked = 0;
+    elem->terminated = 1;
+}
+
+/**
+ * Records data of a process that has just been preempted (or found stopped/exited) : performance counters,
+ * CPU it executed on and resident set size. Must be called before process is reaped.
+ * @param (elem) : ReadyQueue element of process
+ * @param (placement) : CPU placement data
+ */
+static void recordPreempt(ReadyQueue *elem, Placement *placement) {
+    pid_t pid = elem->pcb->pid;
+
+    readPerfCounters(elem->pcb->perf_fds, elem->counters);//read counters on every preempt
+
+    //record CPU process actually executed on (differs from the CPU it was pinned to only if pinning failed)
+    int ran_on = readLastCPU(pid);
+    if (ran_on >= 0 && ran_on != elem->last_cpu) {
+        if (elem->last_cpu >= 0) elem->num_migrations += 1;
+        moveHome(placement, elem->last_cpu, ran_on);
+        elem->last_cpu = ran_on;
+        elem->last_node = nodeOfCPU(placement, ran_on);
+    }
+
+    //CPU time used by process is not load from other work on its CPU
+    long long run_time = readRunTime(pid);
+    if (run_time >= 0) {
+        addJobTime(placement, ran_on, run_time - elem->run_time);
+        elem->run_time = run_time;
+    }
+
+    //record resident set size to predict memory needed by next CPU burst
+    long rss = readRSS(pid);
+    if (rss >= 0) {
+        elem->rss_growth_kb = (elem->rss_kb < 0) ? 0 : rss - elem->rss_kb;
+        elem->rss_kb = rss;
+        if (rss > elem->peak_rss_kb) elem->peak_rss_kb = rss;
+    }
+}
+
+/**
+ * Reaps a process if it has terminated and records its completion (a terminated process no longer has a home CPU)
+ * @param (elem) : ReadyQueue element of process
+ * @param (placement) : CPU placement data
+ * @param (end) : time at which process was last found running or stopped
+ * @return : true if process has terminated; false otherwise
+ */
+static bool reapIfTerminated(ReadyQueue *elem, Placement *placement, struct timespec *end) {
+    int status;
+    struct rusage usage;
+    pid_t pid = elem->pcb->pid;
+
+    pid_t reaped = wait4(pid, &status, WNOHANG, &usage);//use WNOHANG to prevent suspention or waiting
+    if (reaped == 0) return false;
+
+    completeProcess(elem, end, reaped == pid ? &usage : NULL);
+    moveHome(placement, elem->last_cpu, -1);
+    return true;
+}
+
+/**
+ * Timer callback queueing a blocked process for a check of whether it has become runnable
+ * @param (timer) : the recheck timer that fired (recheck_timer of the blocked process)
+ * @param (arg) : RoundRobinState of the round robin run
+ */
+static void queueRecheck(Timer *timer, void *arg) {
+    RoundRobinState *state = arg;
+    ReadyQueue *elem = (ReadyQueue *)((char *) timer - offsetof(ReadyQueue, recheck_timer));
+    elem->due_next = state->due_rechecks;
+    state->due_rechecks = elem;
+}
 
-            int status;
-            waitpid(pid, &status, 0);//wait until process has finished
+/**
+ * Inserts a process into the ring of ready processes, just before the cursor (end of current round)
+ * @param (cursor) : the ready process to execute next (NULL if ring is empty)
+ * @param (elem) : ReadyQueue element of process to insert
+ */
+static void insertReady(ReadyQueue **cursor, ReadyQueue *elem) {
+    if (*cursor == NULL) {
+        elem->run_next = elem;
+        elem->run_prev = elem;
+        *cursor = elem;
+        return;
+    }
+    elem->run_next = *cursor;
+    elem->run_prev = (*cursor)->run_prev;
+    (*cursor)->run_prev->run_next = elem;
+    (*cursor)->run_prev = elem;
+}
 
-            clock_gettime(CLOCK_MONOTONIC, &end);
+/**
+ * Removes a process from the ring of ready processes (when it blocks or terminates)
+ * @param (cursor) : the ready process to execute next (set to NULL if ring becomes empty)
+ * @param (elem) : ReadyQueue element of process to remove
+ */
+static void removeReady(ReadyQueue **cursor, ReadyQueue *elem) {
+    if (elem->run_next == elem) {
+        *cursor = NULL;
+    }
+    else {
+        if (*cursor == elem) *cursor = elem->run_next;
+        elem->run_prev->run_next = elem->run_next;
+        elem->run_next->run_prev = elem->run_prev;
+    }
+    elem->run_next = NULL;
+    elem->run_prev = NULL;
+}
 
-            //set turn around time as difference between arrival time and completion time
-            head->turnaround_time = (end.tv_sec - head->arrival_time_sec)
-                                    + (double)(end.tv_nsec - head->arrival_time_nano)/1000000000L;
+/**
+ * Parks a process held back by memory admission control : it is taken out of the ring of ready processes and
+ * queued behind older parked processes until memory pressure drops (checked every MEMORY_POLL_INTERVAL)
+ * @param (state) : state of the round robin run
+ * @param (elem) : ReadyQueue element of (stopped) process to park
+ */
+static void parkProcess(RoundRobinState *state, ReadyQueue *elem) {
+    printf("\nParking [%s] with PID = [%d] : memory pressure\n", elem->pcb->path, elem->pcb->pid);
+    elem->num_parked += 1;
+
+    removeReady(&state->cursor, elem);
+    elem->parked_next = NULL;
+    if (state->parked_tail) state->parked_tail->parked_next = elem;
+    else state->parked_head = elem;
+    state->parked_tail = elem;
+
+    if (!state->admission_timer.pending) {
+        addTimer(state->wheel, &state->admission_timer, MEMORY_POLL_INTERVAL, setFlagOnExpiry,
+                 &state->admission_check_due);
+    }
+}
 
-            head->burst_time += (end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec)/1000000000L;
-            //calculate waiting time as difference between turnaround time and burst time
-            head->waiting_time = head->turnaround_time - head->burst_time;
+/**
+ * Returns the oldest parked process to the ring of ready processes (end of current round)
+ * @param (state) : state of the round robin run
+ * @return : ReadyQueue element of process returned to the ring
+ */
+static ReadyQueue *unparkOldest(RoundRobinState *state) {
+    ReadyQueue *elem = state->parked_head;
+    state->parked_head = elem->parked_next;
+    if (state->parked_head == NULL) state->parked_tail = NULL;
+    elem->parked_next = NULL;
+
+    insertReady(&state->cursor, elem);
+    return elem;
+}
 
-            head->num_bursts = 1;
-            head->terminated = 1;
+/**
+ * Returns parked processes to the ring of ready processes, oldest first, while memory admission control admits
+ * them. Stops at the first process still held back, so one check costs a single pressure/memory sample.
+ * @param (state) : state of the round robin run
+ */
+static void readmitParked(RoundRobinState *state) {
+    state->admission_check_due = false;
+
+    while (state->parked_head && admitJob(state->parked_head->rss_kb, state->parked_head->rss_growth_kb)) {
+        unparkOldest(state);
+    }
+    if (state->parked_head) {
+        addTimer(state->wheel, &state->admission_timer, MEMORY_POLL_INTERVAL, setFlagOnExpiry,
+                 &state->admission_check_due);
+    }
+}
+
+/**
+ * Checks the blocked (stopped) processes whose recheck timer has fired. A process is first continued for one timer
+ * wheel tick (a sleep that expired while it was stopped, or completed I/O, makes it runnable at once) and then
+ * stopped again : a process that is still blocked is checked again after twice its previous interval (at most
+ * BLOCKED_MAX_RECHECK_INTERVAL); a process that has become runnable (or exited) is returned to the ring of ready
+ * processes, so it only runs again when round robin gives it a time quantum (after memory admission). CPU time it
+ * used while being checked is added to its burst time.
+ * @param (state) : state of the round robin run
+ */
+static void recheckBlocked(RoundRobinState *state) {
+    while (state->due_rechecks) {
+        ReadyQueue *elem = state->due_rechecks;
+        state->due_rechecks = elem->due_next;
+        elem->due_next = NULL;
+
+        pid_t pid = elem->pcb->pid;
+
+        //continue process for one tick to find out whether it is still blocked
+        if (!elem->probing) {
+            elem->probing = 1;
+            kill(pid, SIGCONT);
+            addTimer(state->wheel, &elem->recheck_timer, TIMER_WHEEL_TICK, queueRecheck, state);
+            continue;
         }
-        head=head->next;
+        elem->probing = 0;
+
+        //read state before stopping process : a stopped process is not in a sleeping state
+        bool still_blocked = isBlocked(pid);
+        kill(pid, SIGSTOP);
+
+        if (still_blocked) {
+            //back off : a long sleeper is checked every BLOCKED_MAX_RECHECK_INTERVAL instead of every BLOCKED_POLL_INTERVAL
+            elem->recheck_interval *= 2;
+            if (elem->recheck_interval > BLOCKED_MAX_RECHECK_INTERVAL) {
+                elem->recheck_interval = BLOCKED_MAX_RECHECK_INTERVAL;
+            }
+            addTimer(state->wheel, &elem->recheck_timer, elem->recheck_interval, queueRecheck, state);
+            continue;
+        }
+
+        struct timespec end;
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        //account CPU time process used since it blocked as burst time, the rest as blocked time
+        double cpu_time = 0;
+        long long run_time = readRunTime(pid);
+        if (run_time > elem->blocked_run_time && elem->blocked_run_time >= 0) {
+            cpu_time = (double)(run_time - elem->blocked_run_time)/1000000000L;
+        }
+        double elapsed = (end.tv_sec + (double)end.tv_nsec/1000000000L) - elem->blocked_since;
+        elem->burst_time += cpu_time;
+        if (elapsed > cpu_time) elem->blocked_time += elapsed - cpu_time;
+
+        recordPreempt(elem, state->placement);
+
+        elem->blocked = 0;
+        state->num_blocked -= 1;
+
+        if (reapIfTerminated(elem, state->placement, &end)) state->num_terminated += 1;
+        else insertReady(&state->cursor, elem);
     }
-    printf("\n-------------------------FINISHED-------------------------\n");
-}//end shortestJobFirst()
+}
 
 /**
  * Executes the processes (PCBs) according to round robin scheduler schema
+ * Each process is resumed on the CPU it last executed on unless other work keeps that CPU busier than the least
+ * loaded CPU by more than MIGRATION_THRESHOLD
+ * Memory-hungry (or not yet run) processes are parked (kept stopped and out of the ring) while memory pressure is
+ * high or their growth does not fit; the oldest is readmitted once pressure drops, or forced to run when no other
+ * process can make progress
+ * A process that blocks (sleeps) gives up the rest of its time quantum and is stopped until it becomes runnable.
+ * Its wait still overlaps with other processes : a stopped sleep keeps its expiry and pending I/O completes. At each
+ * recheck the process is continued for one timer wheel tick : if it is then runnable it waits (stopped) for its
+ * next time quantum, otherwise it is stopped again, so it never executes for more than a tick outside its quantum.
+ * (A runnable phase shorter than a tick may complete while the process is checked; its CPU time is burst time.)
+ * Only ready processes are kept in the round robin ring; terminated and blocked processes are unlinked from it.
+ * Time quanta, polling intervals and per-process rechecks of blocked processes are timers on a hierarchical
+ * timer wheel driven by a single timerfd. A process that stays blocked is rechecked at exponentially growing
+ * intervals (up to BLOCKED_MAX_RECHECK_INTERVAL), so long sleepers cost fewer /proc reads.
  * @param (queue) : ReadyQueue of processes to execute according to round robin schema
  * @param (time_quantum) : the round robin time time_quantum
  * @param (size) : the number of PCBs in ready queue
  */
 void roundRobin(ReadyQueue *queue, useconds_t time_quantum, size_t size) {
-    makeQueueCyclic(queue);
+    RoundRobinState state;
+    memset(&state, 0, sizeof(RoundRobinState));//no ready, blocked, parked or terminated processes yet
+
+    //all processes start in the ring of ready processes
+    ReadyQueue *temp = queue;
+    for (size_t i = 0; temp && i < size; i++) {
+        insertReady(&state.cursor, temp);
+        temp = temp->next;
+    }
+
+    ReadyQueue *forced = NULL;//parked process run despite memory pressure because no other process could run
 
-    ReadyQueue *elem = queue; //the the head of queue
+    state.placement = createPlacement();//CPU topology and load for cache/NUMA-aware placement
 
-    size_t num_terminated = 0;//number of terminated processes
+    //all time quanta and polling intervals are timers on one timer wheel
+    state.wheel = createTimerWheel();
+    if (state.wheel == NULL) {
+        freePlacement(state.placement);
+        return;
+    }
+    TimerWheel *wheel = state.wheel;
+    Timer quantum_timer = {0};//expiry of running process's time quantum
+    Timer blocked_timer = {0};//next check of whether running process has blocked or exited
+    Timer memory_timer = {0};//next check of memory pressure
 
     printf("\n--------------------EXECUTING PROCESSES--------------------\n");
 
-    //iterate through the queue
-    while (elem) {
-        //check that process has not terminated
-        if (elem->terminated == 0) {
-            pid_t pid = elem->pcb->pid;
+    //execute ready processes until all processes are terminated
+    while (state.num_terminated < size) {
+        //no ready process and none blocked : only parked processes are left, force the oldest one to run
+        if (state.cursor == NULL && state.num_blocked == 0 && state.parked_head) {
+            forced = unparkOldest(&state);
+            printf("\nResuming [%s] with PID = [%d] despite memory pressure : no other process can run\n",
+                   forced->pcb->path, forced->pcb->pid);
+        }
+
+        //no ready process : wait for a blocked process to become runnable or a parked process to be admitted
+        if (state.cursor == NULL) {
+            if (waitTimerWheel(wheel) < 0) break;
+            recheckBlocked(&state);
+            if (state.admission_check_due) readmitParked(&state);
+            continue;
+        }
+
+        ReadyQueue *elem = state.cursor;
+        pid_t pid = elem->pcb->pid;
+
+        //start & end time objects
+        struct timespec start, end;
+
+        //park process if memory does not fit
+        if (elem != forced && !admitJob(elem->rss_kb, elem->rss_growth_kb)) {
+            parkProcess(&state, elem);
+            continue;
+        }
+
+        //resume process on its last CPU (or migrate it if other work keeps that CPU busy)
+        int cpu = choosePlacement(state.placement, elem->last_cpu);
+        if (cpu >= 0 && pinToCPU(pid, cpu) == 0) {
+            if (elem->last_cpu >= 0 && cpu != elem->last_cpu) elem->num_migrations += 1;
+            moveHome(state.placement, elem->last_cpu, cpu);
+            elem->last_cpu = cpu;
+            elem->last_node = nodeOfCPU(state.placement, cpu);
+        }
 
-            printf("\nExecuting CPU burst on [%s] with PID = [%d]\n", elem->pcb->path, pid);
+        printf("\nExecuting CPU burst on [%s] with PID = [%d] on CPU = [%d]\n", elem->pcb->path, pid, elem->last_cpu);
 
-            //start & end time objects
-            struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
 
-            clock_gettime(CLOCK_MONOTONIC, &start);
+        //Execute CPU burst on process
+        kill(pid, SIGCONT); //resume (start) process
 
-            //Execute CPU burst on process
-            kill(pid, SIGCONT); //resume (start) process
-            usleep(time_quantum);//allow process to execute for time quantum
-            kill(pid, SIGSTOP); //stop process
+        //allow process to execute for time quantum, ending it early if process blocks, exits or memory pressure rises
+        bool quantum_expired = false, blocked_check_due = false, memory_check_due = false;
+        bool yielded = false, memory_parked = false;
+        addTimer(wheel, &quantum_timer, time_quantum, setFlagOnExpiry, &quantum_expired);
+        addTimer(wheel, &blocked_timer, BLOCKED_POLL_INTERVAL, setFlagOnExpiry, &blocked_check_due);
+        addTimer(wheel, &memory_timer, MEMORY_POLL_INTERVAL, setFlagOnExpiry, &memory_check_due);
 
-            clock_gettime(CLOCK_MONOTONIC, &end);
+        while (!quantum_expired && waitTimerWheel(wheel) >= 0) {
+            //check whether blocked processes have become runnable
+            recheckBlocked(&state);
+            if (state.admission_check_due) readmitParked(&state);
 
-            elem->burst_time+=(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec)/1000000000L;
-            elem->num_bursts+=1;
+            if (quantum_expired) break;
 
-            //Check if process has terminated
-            int status;
-            if (waitpid(pid, &status, WNOHANG) != 0){ //use WNOHANG to prevent suspention or waiting
-                //set turn around time as difference between arrival time and completion time
-                elem->turnaround_time = (end.tv_sec - elem->arrival_time_sec)
-                                        + (double)(end.tv_nsec - elem->arrival_time_nano)/1000000000L;
-                //calculate waiting time as difference between turnaround time and burst time
-                elem->waiting_time = elem->turnaround_time - elem->burst_time;
+            if (blocked_check_due) {
+                blocked_check_due = false;
 
-                elem->terminated = 1;
-                num_terminated += 1;
+                if (hasExited(pid)) break;
+
+                if (isBlocked(pid)) {
+                    yielded = true;
+                    break;
+                }
+                addTimer(wheel, &blocked_timer, BLOCKED_POLL_INTERVAL, setFlagOnExpiry, &blocked_check_due);
             }
-        }//end if
-        if (num_terminated >= size) {//if all processes are terminated then break while loop
-            break;
+
+            if (memory_check_due) {
+                memory_check_due = false;
+                if (elem != forced && shouldPark(readRSS(pid))) {
+                    memory_parked = true;
+                    break;
+                }
+                addTimer(wheel, &memory_timer, MEMORY_POLL_INTERVAL, setFlagOnExpiry, &memory_check_due);
+            }
+        }
+        cancelTimer(wheel, &quantum_timer);
+        cancelTimer(wheel, &blocked_timer);
+        cancelTimer(wheel, &memory_timer);
+
+        //stop process (a blocked process keeps sleeping or waiting on I/O while stopped)
+        kill(pid, SIGSTOP);
+
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        double elapsed = (end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec)/1000000000L;
+        long long slice_run_time = elem->run_time;//CPU time of process when its time quantum began
+
+        recordPreempt(elem, state.placement);
+
+        //a process that blocked slept through part of its time quantum : only the CPU time it used is burst time,
+        //the rest is blocked time (as after it yields), so burst, blocked and waiting time add up to turnaround time
+        double cpu_time = (double)(elem->run_time - slice_run_time)/1000000000L;
+        if (yielded && elem->run_time > slice_run_time && cpu_time < elapsed) {
+            elem->burst_time += cpu_time;
+            elem->blocked_time += elapsed - cpu_time;
+        }
+        else {
+            elem->burst_time += elapsed;
+        }
+        elem->num_bursts+=1;
+
+        state.cursor = elem->run_next;
+        forced = NULL;
+
+        if (yielded) {
+            //take process out of the ring (stopped) until a recheck finds it runnable
+            removeReady(&state.cursor, elem);
+            elem->blocked = 1;
+            elem->num_yields += 1;
+            elem->blocked_run_time = readRunTime(pid);
+            elem->blocked_since = end.tv_sec + (double)end.tv_nsec/1000000000L;
+            elem->recheck_interval = BLOCKED_POLL_INTERVAL;
+            addTimer(wheel, &elem->recheck_timer, elem->recheck_interval, queueRecheck, &state);
+            state.num_blocked += 1;
+        }
+        else if (reapIfTerminated(elem, state.placement, &end)) {//Check if process has terminated
+            removeReady(&state.cursor, elem);
+            state.num_terminated += 1;
+        }
+        else if (memory_parked) {
+            parkProcess(&state, elem);
         }
-        elem = elem->next;
     }//end while
+
+    freeTimerWheel(wheel);//pending rechecks are dropped with the timer wheel
+    freePlacement(state.placement);
     printf("\n-------------------------FINISHED-------------------------\n");
 }//end roundRobin()
 
@@ -293,6 +748,8 @@ void roundRobin(ReadyQueue *queue, useconds_t time_quantum, size_t size) {
      double total_time = 0;//total cpu time spent
      double total_turnaround_time = 0;//total turnaround tim
      double total_wait_time = 0;//total cpu waiting time
+     long long total_counters[NUM_PERF_COUNTERS];//counters summed over all processes (-1 if unavailable)
+     for (int i = 0; i < NUM_PERF_COUNTERS; i++) total_counters[i] = -1;
 
      printf("\nSUMMARY:\n");
 
@@ -301,8 +758,18 @@ void roundRobin(ReadyQueue *queue, useconds_t time_quantum, size_t size) {
          total_turnaround_time += temp->turnaround_time;
          total_wait_time += temp->waiting_time;
 
-         printf(" Program [%s] with PID=[%d] executed for [%d] CPU burst with total time = [%lf]\n",
-                temp->pcb->path, temp->pcb->pid, temp->num_bursts, temp->burst_time);
+         printf(" Program [%s] with PID=[%d] executed for [%d] CPU burst with total time = [%lf]"
+                " (last CPU = [%d], node = [%d], migrations = [%d])\n",
+                temp->pcb->path, temp->pcb->pid, temp->num_bursts, temp->burst_time,
+                temp->last_cpu, temp->last_node, temp->num_migrations);
+         printf("    peak RSS = [%ld kB] parked = [%d] yielded while blocked = [%d] blocked time = [%lf]\n",
+                temp->peak_rss_kb, temp->num_parked, temp->num_yields, temp->blocked_time);
+         printPerfCounters(temp->counters);
+
+         for (int i = 0; i < NUM_PERF_COUNTERS; i++) {
+             if (temp->counters[i] < 0) continue;
+             total_counters[i] = (total_counters[i] < 0 ? 0 : total_counters[i]) + temp->counters[i];
+         }
         temp = temp->next;
         counter+=1;
      }
@@ -312,4 +779,7 @@ void roundRobin(ReadyQueue *queue, useconds_t time_quantum, size_t size) {
      printf("\n Average CPU Burst Time : [%lf]", total_time/(double)num_processes);
      printf("\n Average CPU Turnaround Time : [%lf]", total_turnaround_time/(double)num_processes);
      printf("\n Average CPU Waiting Time : [%lf]\n", total_wait_time/((double)num_processes));
+
+     printf("\nPERFORMANCE COUNTERS (all processes):\n");
+     printPerfCounters(total_counters);
  }
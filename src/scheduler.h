@@ -8,12 +8,29 @@
 #include <limits.h>
 #include <signal.h>
 #include <sys/wait.h>
+#include <sys/resource.h>
 #include <string.h>
+#include <stddef.h>
 #include <time.h>
 #include <ctype.h>
 #include <assert.h>
 
 #include "sched.h"
+#include "affinity.h"
+#include "memctl.h"
+#include "timerwheel.h"
+
+/**
+ * Interval (microseconds) at which the running process is checked, and first interval at which a blocked process
+ * is rechecked (doubled while it stays blocked, up to BLOCKED_MAX_RECHECK_INTERVAL)
+ */
+#define BLOCKED_POLL_INTERVAL 10000
+
+/**
+ * Longest interval (microseconds) between two rechecks of a blocked process : a few BLOCKED_POLL_INTERVALs, so a
+ * process that wakes is found soon and only long sleepers are checked less often
+ */
+#define BLOCKED_MAX_RECHECK_INTERVAL (4 * BLOCKED_POLL_INTERVAL)
 
 /**
  * contains execution/scheduling data (time measurements, state)
@@ -36,21 +53,57 @@ typedef struct ReadyQueue  {
     //time between arrival process and beginning of CPU burst
     double waiting_time;
 
+    int last_cpu; //CPU process last executed on (-1 if not yet executed)
+    int last_node; //NUMA node of CPU process last executed on (-1 if not yet executed)
+    int num_migrations; //number of times process was moved to a different CPU
+    long long run_time; //CPU time (ns) of process when it was last preempted
+
+    long long counters[NUM_PERF_COUNTERS]; //cumulative performance counter values (-1 if unavailable)
+
+    long rss_kb; //resident set size (kB) after last CPU burst (-1 before first CPU burst)
+    long peak_rss_kb; //largest resident set size (kB) observed
+    long rss_growth_kb; //growth of resident set (kB) during last CPU burst (predicts next burst)
+    int num_parked; //number of times process was held stopped because of memory pressure
+    struct ReadyQueue *parked_next; //next (younger) process held out of round robin by memory admission control
+
+    int blocked; //1 if process gave up its time quantum because it blocked (kept stopped until runnable); 0 otherwise
+    int probing; //1 while blocked process is continued for one tick to check whether it is still blocked
+    int num_yields; //number of time quanta given up early because process blocked
+    long long blocked_run_time; //CPU time (ns) of process when it blocked (-1 if unknown)
+    double blocked_since; //time (seconds, CLOCK_MONOTONIC) when process last blocked
+    double blocked_time; //total time process spent blocked (sleeping/waiting on I/O), excluded from waiting time
+    Timer recheck_timer; //next check of whether blocked process has become runnable
+    useconds_t recheck_interval; //current interval (microseconds) between rechecks of blocked process
+    struct ReadyQueue *due_next; //next blocked process whose recheck timer has fired
+
+    struct ReadyQueue *run_next; //next process in round robin ring of ready processes
+    struct ReadyQueue *run_prev; //previous process in round robin ring of ready processes
+
     struct ReadyQueue *next; //next process in ReadyQueue
     struct ReadyQueue *prev; //previous process in ReadyQueue
 } ReadyQueue;
 
 /**
- * populates ready queue with PCBs
- * @param (pcb_list) : the list of PCBs to populate ReadyQueue with
+ * State of one round robin run, passed to timer callbacks as their argument
  */
-ReadyQueue *createQueue(PCB *pcb_list);
+typedef struct RoundRobinState {
+    TimerWheel *wheel; //timer wheel holding time quanta, polling intervals and rechecks of blocked processes
+    Placement *placement; //CPU topology and load for cache/NUMA-aware placement
+    ReadyQueue *cursor; //next ready process to execute (cursor into ring of ready processes, NULL if ring is empty)
+    ReadyQueue *due_rechecks; //blocked processes whose recheck timer has fired and that still need to be checked
+    ReadyQueue *parked_head; //oldest process held out of the ring by memory admission control (NULL if none)
+    ReadyQueue *parked_tail; //youngest process held out of the ring by memory admission control
+    Timer admission_timer; //next check of whether the oldest parked process may be admitted
+    bool admission_check_due; //set when admission_timer fires
+    size_t num_blocked; //number of blocked processes
+    size_t num_terminated; //number of terminated processes
+} RoundRobinState;
 
 /**
- * Given a ready queue, makes the queue cyclic by connecting head and tail nodes
- * @param (queue) : the ready queue to make cyclic
+ * populates ready queue with PCBs
+ * @param (pcb_list) : the list of PCBs to populate ReadyQueue with
  */
-void makeQueueCyclic(ReadyQueue *queue);
+ReadyQueue *createQueue(PCB *pcb_list);
 
 /**
  * frees memory of ReadyQueue by freeing all nodes
@@ -82,6 +135,24 @@ ReadyQueue *divideQueue(ReadyQueue *queue);
   */
 ReadyQueue *mergeSort(ReadyQueue *queue, int mode);
 
+/**
+ * Holds a process stopped until memory admission control admits it (at most ADMISSION_MAX_WAIT)
+ * Memory pressure is rechecked every MEMORY_POLL_INTERVAL on the timer wheel
+ * @param (wheel) : the timer wheel to wait on (process is admitted at once if NULL)
+ * @param (elem) : ReadyQueue element of process to admit
+ */
+void waitForAdmission(TimerWheel *wheel, ReadyQueue *elem);
+
+/**
+ * Executes a process until it terminates (for run-to-completion schedulers) and records its burst, blocked,
+ * turnaround and waiting time. As in round robin, burst time is the CPU time the process used and the rest of its
+ * execution is blocked time. A memory-hungry process is parked (stopped) while memory pressure is high, which does
+ * not change the order in which processes complete. Exit and memory pressure are checked on the timer wheel.
+ * @param (wheel) : the timer wheel to wait on (process is waited for without memory checks if NULL)
+ * @param (elem) : ReadyQueue element of (admitted) process to execute
+ */
+void runToCompletion(TimerWheel *wheel, ReadyQueue *elem);
+
 /**
  * Simple Priority Scheduler : execute processes from a ready-queue in order based on priority of processes
  * @param (queue) : ReadyQueue of processes to execute (sorted by priority value)
@@ -95,8 +166,31 @@ void simplePriority(ReadyQueue *queue);
  */
 void shortestJobFirst(ReadyQueue *queue);
 
+/**
+ * Records turnaround and waiting time of a process that has terminated and been reaped, and closes its
+ * performance counters (their final values must already have been read)
+ * @param (elem) : ReadyQueue element of terminated process
+ * @param (end) : time at which process was found to have terminated
+ * @param (usage) : resource usage of terminated process from wait4 (NULL if wait4 did not reap it)
+ */
+void completeProcess(ReadyQueue *elem, struct timespec *end, struct rusage *usage);
+
 /**
  * Executes the processes (PCBs) according to round robin scheduler schema
+ * Each process is resumed on the CPU it last executed on unless other work keeps that CPU busier than the least
+ * loaded CPU by more than MIGRATION_THRESHOLD
+ * Memory-hungry (or not yet run) processes are parked (kept stopped and out of the ring) while memory pressure is
+ * high or their growth does not fit; the oldest is readmitted once pressure drops, or forced to run when no other
+ * process can make progress
+ * A process that blocks (sleeps) gives up the rest of its time quantum and is stopped until it becomes runnable.
+ * Its wait still overlaps with other processes : a stopped sleep keeps its expiry and pending I/O completes. At each
+ * recheck the process is continued for one timer wheel tick : if it is then runnable it waits (stopped) for its
+ * next time quantum, otherwise it is stopped again, so it never executes for more than a tick outside its quantum.
+ * (A runnable phase shorter than a tick may complete while the process is checked; its CPU time is burst time.)
+ * Only ready processes are kept in the round robin ring; terminated and blocked processes are unlinked from it.
+ * Time quanta, polling intervals and per-process rechecks of blocked processes are timers on a hierarchical
+ * timer wheel driven by a single timerfd. A process that stays blocked is rechecked at exponentially growing
+ * intervals (up to BLOCKED_MAX_RECHECK_INTERVAL), so long sleepers cost fewer /proc reads.
  * @param (queue) : ReadyQueue of processes to execute according to round robin schema
  * @param (time_quantum) : the round robin time time_quantum
  * @param (size) : the number of PCBs in ready queue
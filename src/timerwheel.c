@@ -0,0 +1,313 @@
+#include <errno.h>
+#include <poll.h>
+#include <sys/timerfd.h>
+
+#include "timerwheel.h"
+
+/**
+ * Calculates the current tick from the monotonic clock
+ * @param (wheel) : the TimerWheel
+ * @return : number of whole ticks since wheel was created
+ */
+static uint64_t currentTick(TimerWheel *wheel) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    int64_t elapsed = (int64_t) (time.tv_sec - wheel->epoch.tv_sec) * 1000000000LL
+                      + (time.tv_nsec - wheel->epoch.tv_nsec);
+    if (elapsed < 0) return 0;
+    return (uint64_t) elapsed / (TIMER_WHEEL_TICK * 1000ULL);
+}
+
+/**
+ * Finds the tick at which the wheel next has work : the earliest level 0 expiry or the tick at which
+ * the earliest non-empty slot of a higher level is cascaded (whichever comes first)
+ * @param (wheel) : the TimerWheel
+ * @return : tick of next work (UINT64_MAX if no timers are pending)
+ */
+static uint64_t nextExpiry(TimerWheel *wheel) {
+    uint64_t next = UINT64_MAX;
+
+    for (int level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+        if (wheel->level_timers[level] == 0) continue;
+
+        int shift = TIMER_WHEEL_BITS * level;
+        uint64_t base = wheel->now >> shift;
+
+        //slot of current position is only reached again this rotation if now is at its start
+        bool aligned = (wheel->now & (((uint64_t) 1 << shift) - 1)) == 0;
+        int first = aligned ? 0 : 1;
+
+        for (int offset = first; offset < first + TIMER_WHEEL_SLOTS; offset++) {
+            if (wheel->slots[level][(base + offset) & TIMER_WHEEL_MASK]) {
+                uint64_t tick = (base + offset) << shift;
+                if (tick < next) next = tick;
+                break;
+            }
+        }
+    }
+    return next;
+}
+
+/**
+ * Arms the one-shot timerfd to expire at the start of a tick
+ * @param (wheel) : the TimerWheel whose timerfd to set
+ * @param (tick) : the tick to expire at
+ */
+static void armTimerWheel(TimerWheel *wheel, uint64_t tick) {
+    uint64_t offset = tick * (TIMER_WHEEL_TICK * 1000ULL) + (uint64_t) wheel->epoch.tv_nsec;
+
+    struct itimerspec spec;
+    memset(&spec, 0, sizeof(spec));
+    spec.it_value.tv_sec = wheel->epoch.tv_sec + (time_t) (offset / 1000000000ULL);
+    spec.it_value.tv_nsec = (long) (offset % 1000000000ULL);
+
+    //a zero it_value would disarm the timer
+    if (spec.it_value.tv_sec == 0 && spec.it_value.tv_nsec == 0) spec.it_value.tv_nsec = 1;
+
+    if (timerfd_settime(wheel->fd, TFD_TIMER_ABSTIME, &spec, NULL) != 0) {
+        perror("ERROR : cannot set timerfd");
+    }
+}
+
+/**
+ * Links a timer into the slot matching its expiry : level 0 if it expires within 64 ticks,
+ * otherwise the lowest level whose range covers it
+ * @param (wheel) : the TimerWheel to link timer into
+ * @param (timer) : the timer to link (expires must be set)
+ */
+static void linkTimer(TimerWheel *wheel, Timer *timer) {
+    if (timer->expires < wheel->now) timer->expires = wheel->now;
+
+    uint64_t delta = timer->expires - wheel->now;
+    if (delta > TIMER_WHEEL_MAX_DELAY) {
+        delta = TIMER_WHEEL_MAX_DELAY;
+        timer->expires = wheel->now + delta;
+    }
+
+    int level = 0;
+    while (level < TIMER_WHEEL_LEVELS - 1 && delta >> (TIMER_WHEEL_BITS * (level + 1))) level++;
+
+    int index = (timer->expires >> (TIMER_WHEEL_BITS * level)) & TIMER_WHEEL_MASK;
+
+    timer->level = level;
+    timer->slot = &wheel->slots[level][index];
+    timer->prev = NULL;
+    timer->next = *timer->slot;
+    if (timer->next) timer->next->prev = timer;
+    *timer->slot = timer;
+
+    wheel->level_timers[level] += 1;
+}
+
+/**
+ * Unlinks a timer from its slot
+ * @param (wheel) : the TimerWheel holding the timer
+ * @param (timer) : the timer to unlink
+ */
+static void unlinkTimer(TimerWheel *wheel, Timer *timer) {
+    if (timer->prev) timer->prev->next = timer->next;
+    else *timer->slot = timer->next;
+    if (timer->next) timer->next->prev = timer->prev;
+
+    wheel->level_timers[timer->level] -= 1;
+
+    timer->slot = NULL;
+    timer->prev = NULL;
+    timer->next = NULL;
+}
+
+/**
+ * Moves all timers of one slot of a higher level down into lower levels
+ * @param (wheel) : the TimerWheel to cascade
+ * @param (level) : the level to cascade from
+ * @param (index) : the slot to cascade
+ * @return : the slot index cascaded (0 means the next level must be cascaded too)
+ */
+static int cascade(TimerWheel *wheel, int level, int index) {
+    Timer *timer = wheel->slots[level][index];
+    wheel->slots[level][index] = NULL;
+
+    while (timer) {
+        Timer *next = timer->next;
+        wheel->level_timers[level] -= 1;
+        linkTimer(wheel, timer);
+        timer = next;
+    }
+    return index;
+}
+
+/**
+ * Creates an empty timer wheel and its timerfd
+ * @return : TimerWheel object (NULL if timerfd cannot be created)
+ */
+TimerWheel *createTimerWheel(void) {
+    int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (fd < 0) {
+        perror("ERROR : cannot create timerfd");
+        return NULL;
+    }
+
+    TimerWheel *wheel = calloc(1, sizeof(TimerWheel));
+    wheel->fd = fd;
+    clock_gettime(CLOCK_MONOTONIC, &wheel->epoch);
+    return wheel;
+}
+
+/**
+ * Frees memory of timer wheel and closes its timerfd (pending timers are dropped, not fired)
+ * @param (wheel) : the TimerWheel to free
+ */
+void freeTimerWheel(TimerWheel *wheel) {
+    if (wheel == NULL) return;
+    close(wheel->fd);
+    free(wheel);
+}
+
+/**
+ * Adds a timer to the wheel in O(1). A pending timer is first removed.
+ * @param (wheel) : the TimerWheel to add timer to
+ * @param (timer) : the timer to add
+ * @param (delay) : microseconds from now until timer fires (rounded up to whole ticks)
+ * @param (callback) : function to call when timer fires
+ * @param (arg) : argument passed to callback
+ */
+void addTimer(TimerWheel *wheel, Timer *timer, useconds_t delay,
+              void (*callback)(Timer *timer, void *arg), void *arg) {
+    if (timer->pending) cancelTimer(wheel, timer);
+
+    //fire no earlier than one tick from now
+    uint64_t ticks = (delay + TIMER_WHEEL_TICK - 1) / TIMER_WHEEL_TICK;
+    if (ticks == 0) ticks = 1;
+
+    timer->expires = currentTick(wheel) + ticks;
+    timer->callback = callback;
+    timer->arg = arg;
+    timer->pending = true;
+
+    linkTimer(wheel, timer);
+    wheel->num_timers += 1;
+}
+
+/**
+ * Removes a pending timer from the wheel in O(1) without firing it
+ * @param (wheel) : the TimerWheel holding the timer
+ * @param (timer) : the timer to cancel
+ */
+void cancelTimer(TimerWheel *wheel, Timer *timer) {
+    if (!timer->pending) return;
+
+    unlinkTimer(wheel, timer);
+    timer->pending = false;
+    wheel->num_timers -= 1;
+}
+
+/**
+ * Advances the wheel to the current time, first blocking on the timerfd until the earliest expiry or
+ * cascade point if it has not passed yet
+ * @param (wheel) : the TimerWheel to advance
+ * @return : number of timers fired (-1 if no timers are pending or timerfd cannot be read)
+ */
+int waitTimerWheel(TimerWheel *wheel) {
+    if (wheel->num_timers == 0) return -1;
+
+    uint64_t now = currentTick(wheel);
+    uint64_t next = nextExpiry(wheel);
+
+    //only block if ticks that already elapsed do not reach the next expiry
+    while (next > now) {
+        armTimerWheel(wheel, next);
+
+        struct pollfd pfd = {.fd = wheel->fd, .events = POLLIN, .revents = 0};
+        if (poll(&pfd, 1, -1) < 0 && errno != EINTR) {
+            perror("ERROR : cannot poll timerfd");
+            return -1;
+        }
+
+        uint64_t expirations;
+        if (read(wheel->fd, &expirations, sizeof(expirations)) < 0 && errno != EAGAIN) {
+            perror("ERROR : cannot read timerfd");
+            return -1;
+        }
+        now = currentTick(wheel);
+    }
+
+    //process every tick up to and including the current one
+    if (now < wheel->now) return 0;
+    return advanceTimerWheel(wheel, now - wheel->now + 1);
+}
+
+/**
+ * Blocks until a delay has passed, firing any timers that expire meanwhile
+ * @param (wheel) : the TimerWheel to wait on
+ * @param (delay) : microseconds to wait
+ */
+void waitTimerWheelFor(TimerWheel *wheel, useconds_t delay) {
+    bool expired = false;
+    Timer timer = {0};
+
+    addTimer(wheel, &timer, delay, setFlagOnExpiry, &expired);
+    while (!expired && waitTimerWheel(wheel) >= 0);
+    cancelTimer(wheel, &timer);
+}
+
+/**
+ * Advances the wheel tick by tick, cascading higher levels and firing expired timers
+ * (runs of ticks with no level 0 timers are skipped up to the next cascade of a non-empty slot)
+ * @param (wheel) : the TimerWheel to advance
+ * @param (ticks) : number of ticks to advance by
+ * @return : number of timers fired
+ */
+int advanceTimerWheel(TimerWheel *wheel, uint64_t ticks) {
+    int fired = 0;
+
+    while (ticks > 0 && wheel->num_timers > 0) {
+        int index = wheel->now & TIMER_WHEEL_MASK;
+
+        //nothing in level 0 : skip to the tick at which the next higher level slot is cascaded
+        uint64_t next = (wheel->level_timers[0] == 0) ? nextExpiry(wheel) : wheel->now;
+        if (next > wheel->now) {
+            uint64_t skip = next - wheel->now;
+            if (skip > ticks) skip = ticks;
+            wheel->now += skip;
+            ticks -= skip;
+            continue;
+        }
+
+        //level 0 wrapped : cascade next slot of each higher level while that level wraps too
+        if (index == 0) {
+            for (int level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+                int slot = (wheel->now >> (TIMER_WHEEL_BITS * level)) & TIMER_WHEEL_MASK;
+                if (cascade(wheel, level, slot) != 0) break;
+            }
+        }
+
+        //fire timers one at a time so callbacks may add or cancel other timers
+        Timer *timer;
+        while ((timer = wheel->slots[0][index]) != NULL) {
+            unlinkTimer(wheel, timer);
+            timer->pending = false;
+            wheel->num_timers -= 1;
+
+            timer->callback(timer, timer->arg);
+            fired += 1;
+        }
+
+        wheel->now += 1;
+        ticks -= 1;
+    }
+
+    //no timers left to fire : skip remaining ticks in O(1)
+    wheel->now += ticks;
+    return fired;
+}
+
+/**
+ * Timer callback that sets the bool pointed to by arg
+ * @param (timer) : the timer that fired
+ * @param (arg) : pointer to bool to set
+ */
+void setFlagOnExpiry(Timer *timer, void *arg) {
+    (void) timer;
+    *(bool *) arg = true;
+}
@@ -0,0 +1,121 @@
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * Length of one timer wheel tick (microseconds)
+ */
+#define TIMER_WHEEL_TICK 1000
+
+/**
+ * Number of bits of expiry time handled by each level of the wheel (64 slots per level)
+ */
+#define TIMER_WHEEL_BITS 6
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_MASK (TIMER_WHEEL_SLOTS - 1)
+
+/**
+ * Number of levels of the wheel. Timers up to 64^4 - 1 ticks (~4.6 hours) ahead are supported;
+ * longer delays are clamped to that maximum
+ */
+#define TIMER_WHEEL_LEVELS 4
+#define TIMER_WHEEL_MAX_DELAY (((uint64_t) 1 << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS)) - 1)
+
+/**
+ * A pending timer (quantum expiry, arrival, deadline, priority boost, ...). Owned by the caller.
+ */
+typedef struct Timer {
+    uint64_t expires; //tick at which timer fires
+    void (*callback)(struct Timer *timer, void *arg); //function called when timer fires
+    void *arg; //argument passed to callback
+    bool pending; //true while timer is in the wheel
+
+    int level; //level of wheel holding timer
+    struct Timer **slot; //head of wheel slot list holding timer
+    struct Timer *prev; //previous timer in wheel slot
+    struct Timer *next; //next timer in wheel slot
+} Timer;
+
+/**
+ * Hierarchical timing wheel driven by a single timerfd
+ * Level 0 holds timers expiring within the next 64 ticks (one slot per tick); every higher level covers
+ * 64 times the range of the one below and is cascaded into it as time advances.
+ * The timerfd is one-shot, armed for the earliest level 0 expiry or the next cascade point.
+ */
+typedef struct TimerWheel {
+    uint64_t now; //next tick to be processed
+    Timer *slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS]; //lists of timers per level and slot
+    size_t level_timers[TIMER_WHEEL_LEVELS]; //number of pending timers per level
+    size_t num_timers; //number of pending timers
+    int fd; //one-shot timerfd (absolute CLOCK_MONOTONIC time)
+    struct timespec epoch; //time of tick 0
+} TimerWheel;
+
+/**
+ * Creates an empty timer wheel and its timerfd
+ * @return : TimerWheel object (NULL if timerfd cannot be created)
+ */
+TimerWheel *createTimerWheel(void);
+
+/**
+ * Frees memory of timer wheel and closes its timerfd (pending timers are dropped, not fired)
+ * @param (wheel) : the TimerWheel to free
+ */
+void freeTimerWheel(TimerWheel *wheel);
+
+/**
+ * Adds a timer to the wheel in O(1). A pending timer is first removed.
+ * @param (wheel) : the TimerWheel to add timer to
+ * @param (timer) : the timer to add
+ * @param (delay) : microseconds from now until timer fires (rounded up to whole ticks)
+ * @param (callback) : function to call when timer fires
+ * @param (arg) : argument passed to callback
+ */
+void addTimer(TimerWheel *wheel, Timer *timer, useconds_t delay,
+              void (*callback)(Timer *timer, void *arg), void *arg);
+
+/**
+ * Removes a pending timer from the wheel in O(1) without firing it
+ * @param (wheel) : the TimerWheel holding the timer
+ * @param (timer) : the timer to cancel
+ */
+void cancelTimer(TimerWheel *wheel, Timer *timer);
+
+/**
+ * Advances the wheel to the current time, first blocking on the timerfd until the earliest expiry or
+ * cascade point if it has not passed yet
+ * @param (wheel) : the TimerWheel to advance
+ * @return : number of timers fired (-1 if no timers are pending or timerfd cannot be read)
+ */
+int waitTimerWheel(TimerWheel *wheel);
+
+/**
+ * Blocks until a delay has passed, firing any timers that expire meanwhile
+ * @param (wheel) : the TimerWheel to wait on
+ * @param (delay) : microseconds to wait
+ */
+void waitTimerWheelFor(TimerWheel *wheel, useconds_t delay);
+
+/**
+ * Advances the wheel tick by tick, cascading higher levels and firing expired timers
+ * (runs of ticks with no level 0 timers are skipped up to the next cascade of a non-empty slot)
+ * @param (wheel) : the TimerWheel to advance
+ * @param (ticks) : number of ticks to advance by
+ * @return : number of timers fired
+ */
+int advanceTimerWheel(TimerWheel *wheel, uint64_t ticks);
+
+/**
+ * Timer callback that sets the bool pointed to by arg
+ * @param (timer) : the timer that fired
+ * @param (arg) : pointer to bool to set
+ */
+void setFlagOnExpiry(Timer *timer, void *arg);
+#endif